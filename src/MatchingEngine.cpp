@@ -4,13 +4,21 @@
 #include "Trade.h"
 #include "Order.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <queue>
+#include <stdexcept>
 
 MatchingEngine::MatchingEngine()
+    : MatchingEngine(DEFAULT_TERMINAL_ORDER_RETENTION) {
+}
+MatchingEngine::MatchingEngine(OrderCount terminal_order_retention)
     : order_books_(),
       executed_trades_(),
+      order_states_(terminal_order_retention),
       next_trade_id_(0),
       current_timestamp_(0) {
 }
@@ -26,22 +34,52 @@ OrderBook* MatchingEngine::find_order_book(const Symbol& symbol) {
     return (it != order_books_.end()) ? it->second.get() : nullptr;
 }
 
+// Matches the incoming order, then activates any stops its trades triggered.
+// Triggered stops are queued and matched in the same pass so a cascade never
+// re-enters submit_order
 TradeList MatchingEngine::match_order(Order* incoming_order, OrderBook* order_book) {
     TradeList trades;
+    std::queue<Order*> triggered_orders;
+    Order* order = incoming_order;
+
+    while (order) {
+        size_t trade_count = trades.size();
+        Price low_fill_price = std::numeric_limits<Price>::max();
+        Price high_fill_price = 0;
+        execute_order(order, order_book, trades, low_fill_price, high_fill_price);
+        rest_order(order, order_book);
+
+        if (trades.size() > trade_count) {
+            order_book->set_last_trade_price(trades.back().get_price());
+            order_book->collect_triggered_stops(low_fill_price, high_fill_price, triggered_orders);
+        }
 
+        order = nullptr;
+        if (!triggered_orders.empty()) {
+            order = triggered_orders.front();
+            triggered_orders.pop();
+            order->trigger();
+        }
+    }
+    return trades;
+}
+void MatchingEngine::execute_order(Order* incoming_order, OrderBook* order_book, TradeList& trades,
+                                   Price& low_fill_price, Price& high_fill_price) {
     while (incoming_order->get_remaining_quantity() > 0) {
-        auto* opposing_orders = order_book->get_best_orders(incoming_order->get_side());
-        if (!opposing_orders || opposing_orders->empty()) {
+        PriceLevel* best_level = order_book->get_best_level(incoming_order->get_side());
+        if (!best_level || best_level->orders.empty()) {
             break;
         }
 
-        Order* resting_order = opposing_orders->front();
+        Order* resting_order = best_level->orders.front();
         if (!incoming_order->can_match_with(*resting_order)) {
             break;
         }
 
         Quantity fill_qty = incoming_order->get_fillable_quantity(*resting_order);
         Price execution_price = resting_order->get_price();
+        low_fill_price = std::min(low_fill_price, execution_price);
+        high_fill_price = std::max(high_fill_price, execution_price);
 
         Trade trade = create_trade(incoming_order, resting_order, execution_price, fill_qty);
         trades.push_back(trade);
@@ -49,15 +87,32 @@ TradeList MatchingEngine::match_order(Order* incoming_order, OrderBook* order_bo
 
         incoming_order->fill(fill_qty);
         resting_order->fill(fill_qty);
+        best_level->displayed_quantity -= fill_qty;
 
         if (resting_order->is_filled()) {
-            opposing_orders->pop();
-            if (opposing_orders->empty()) {
-                order_book->cleanup_empty_price_level(execution_price, resting_order->get_side());
-            }
+            order_book->pop_filled_order(execution_price, resting_order->get_side());
+        }
+        else if (resting_order->needs_replenish()) {
+            // Refilled icebergs lose time priority and go to the back of their level
+            best_level->orders.pop();
+            best_level->displayed_quantity += resting_order->replenish();
+            best_level->orders.push(resting_order);
         }
+        order_states_.record_update(*resting_order, execution_price, fill_qty, trade.get_timestamp());
+        order_states_.record_update(*incoming_order, execution_price, fill_qty, trade.get_timestamp());
     }
-    return trades;
+}
+// Limit remainders rest on the book, market remainders are cancelled
+void MatchingEngine::rest_order(Order* order, OrderBook* order_book) {
+    if (order->is_filled()) {
+        return;
+    }
+    if (order->get_order_type() == OrderType::Market) {
+        order->cancel();
+        order_states_.record_update(*order, 0, 0, current_timestamp_++);
+        return;
+    }
+    order_book->add_order(order);
 }
 
 Trade MatchingEngine::create_trade(Order* incoming_order, Order* resting_order, Price price, Quantity qty) {
@@ -72,12 +127,28 @@ TradeList MatchingEngine::submit_order(Order* order) {
     if(!order->is_valid()) {
         throw std::invalid_argument("Cannot submit invalid order");
     }
+    if (order_states_.is_tracked(order->get_order_id())) {
+        throw std::invalid_argument("OrderId already exists");
+    }
     const Symbol& symbol = order->get_symbol();
     auto order_book = find_order_book(symbol);
     if (order_book == nullptr) {
         order_book = create_order_book(symbol);
     }
-    order_book->add_order(order);
+    order->accept();
+    order_states_.record_update(*order, 0, 0, current_timestamp_++);
+    if (order->is_stop_order()) {
+        auto last_trade_price = order_book->get_last_trade_price();
+        if (!last_trade_price.has_value() || !order->is_triggered_by(last_trade_price.value())) {
+            order_book->add_stop_order(order);
+            order_states_.publish_pending();
+            return {};
+        }
+        order->trigger();
+    }
+    TradeList trades = match_order(order, order_book);
+    order_states_.publish_pending();
+    return trades;
 }
 void MatchingEngine::cancel_order(const Symbol &symbol, OrderId order_id) {
     auto it = order_books_.find(symbol);
@@ -85,7 +156,9 @@ void MatchingEngine::cancel_order(const Symbol &symbol, OrderId order_id) {
         return;
     }
     OrderBook* order_book = it->second.get();
-    order_book->cancel_order(order_id);
+    Order* order = order_book->cancel_order(order_id);
+    order_states_.record_update(*order, 0, 0, current_timestamp_++);
+    order_states_.publish_pending();
 }
 const OrderBook* MatchingEngine::get_order_book(const Symbol &symbol) {
     auto it = order_books_.find(symbol);
@@ -103,6 +176,18 @@ TradeList MatchingEngine::get_trades_for_symbol(const Symbol& symbol) const {
     }
     return trades_for_symbol;
 }
+std::optional<OrderState> MatchingEngine::get_order_state(OrderId order_id) const {
+    return order_states_.get_order_state(order_id);
+}
+SubscriptionId MatchingEngine::subscribe_execution_reports(ExecutionReportHandler handler) {
+    return order_states_.subscribe(std::move(handler));
+}
+void MatchingEngine::unsubscribe_execution_reports(SubscriptionId subscription_id) {
+    order_states_.unsubscribe(subscription_id);
+}
+OrderCount MatchingEngine::get_execution_report_error_count() const {
+    return order_states_.get_handler_error_count();
+}
 bool MatchingEngine::has_order_book(const Symbol &symbol) const {
     auto it = order_books_.find(symbol);
     return it != order_books_.end();
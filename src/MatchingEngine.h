@@ -4,9 +4,11 @@
 #include "OrderBook.h"
 #include "Trade.h"
 #include "Order.h"
+#include "OrderStateService.h"
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <queue>
 
 class Order;
 class OrderBook;
@@ -19,21 +21,31 @@ class MatchingEngine {
 private:
     OrderBookMap order_books_;
     TradeList executed_trades_;
+    OrderStateService order_states_;
     TradeId next_trade_id_;
     Timestamp current_timestamp_;
     OrderBook* create_order_book(const Symbol& symbol);
     OrderBook* find_order_book(const Symbol& symbol);
     TradeList match_order(Order* order, OrderBook* order_book);
+    void execute_order(Order* order, OrderBook* order_book, TradeList& trades,
+                       Price& low_fill_price, Price& high_fill_price);
+    void rest_order(Order* order, OrderBook* order_book);
     Trade create_trade(Order* buy_order, Order* sell_order, Price price, Quantity quantity);
     Timestamp get_current_timestamp() const;
-    static Side determine_aggressor(Order* incoming_order) const;
+    static Side determine_aggressor(Order* incoming_order);
 public:
+    static constexpr OrderCount DEFAULT_TERMINAL_ORDER_RETENTION = 100000;
     MatchingEngine();
+    explicit MatchingEngine(OrderCount terminal_order_retention);
     TradeList submit_order(Order* order);
     void cancel_order(const Symbol& symbol, OrderId order_id);
     const OrderBook* get_order_book(const Symbol& symbol);
     const TradeList& get_executed_trades() const;
     TradeList get_trades_for_symbol(const Symbol& symbol) const;
+    std::optional<OrderState> get_order_state(OrderId order_id) const;
+    SubscriptionId subscribe_execution_reports(ExecutionReportHandler handler);
+    void unsubscribe_execution_reports(SubscriptionId subscription_id);
+    OrderCount get_execution_report_error_count() const;
     bool has_order_book(const Symbol& symbol) const;
     OrderCount get_order_book_count() const;
     TradeId get_next_trade_id() const;
@@ -1,16 +1,34 @@
 #include "Types.h"
 #include "Order.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
 Order::Order(OrderId order_id, Side side, Price price, Quantity quantity, const Symbol& symbol,
         Timestamp timestamp, OrderType order_type)
+    : Order(order_id, side, price, quantity, symbol, timestamp, order_type, 0, 0) {
+}
+Order::Order(OrderId order_id, Side side, Price price, Quantity quantity, const Symbol& symbol,
+        Timestamp timestamp, OrderType order_type, Price stop_price)
+    : Order(order_id, side, price, quantity, symbol, timestamp, order_type, stop_price, 0) {
+}
+// Iceberg orders show peak_quantity at a time out of quantity
+Order::Order(OrderId order_id, Side side, Price price, Quantity quantity, Quantity peak_quantity,
+        const Symbol& symbol, Timestamp timestamp)
+    : Order(order_id, side, price, quantity, symbol, timestamp, OrderType::Iceberg, 0, peak_quantity) {
+}
+Order::Order(OrderId order_id, Side side, Price price, Quantity quantity, const Symbol& symbol,
+        Timestamp timestamp, OrderType order_type, Price stop_price, Quantity peak_quantity)
     : order_id_(order_id),
       side_(side),
       price_(price),
+      stop_price_(stop_price),
       quantity_(quantity),
       remaining_quantity_(quantity),
+      filled_quantity_(0),
+      peak_quantity_(peak_quantity),
+      displayed_quantity_(std::min(peak_quantity, quantity)),
       symbol_(symbol),
       timestamp_(timestamp),
       order_type_(order_type),
@@ -19,26 +37,86 @@ Order::Order(OrderId order_id, Side side, Price price, Quantity quantity, const
 OrderId Order::get_order_id() const { return order_id_; }
 Side Order::get_side() const { return side_; }
 Price Order::get_price() const { return price_; }
+Price Order::get_stop_price() const { return stop_price_; }
 Quantity Order::get_quantity() const { return quantity_; }
 Quantity Order::get_remaining_quantity() const { return remaining_quantity_; }
-Quantity Order::get_filled_quantity() const { return quantity_ - remaining_quantity_; }
+Quantity Order::get_filled_quantity() const { return filled_quantity_; }
+Quantity Order::get_peak_quantity() const { return peak_quantity_; }
+Quantity Order::get_displayed_quantity() const {
+    return is_iceberg() ? displayed_quantity_ : remaining_quantity_;
+}
 const Symbol& Order::get_symbol() const { return symbol_; }
 Timestamp Order::get_timestamp() const { return timestamp_; }
 OrderType Order::get_order_type() const { return order_type_; }
 OrderStatus Order::get_status() const { return status_; }
 
+void Order::accept() {
+    status_ = OrderStatus::Accepted;
+}
 void Order::fill(Quantity quantity) {
     if (quantity > remaining_quantity_) {
         throw std::invalid_argument("Fill quantity cannot exceed remaining quantity");
     }
     remaining_quantity_ -= quantity;
+    filled_quantity_ += quantity;
+    if (is_iceberg()) {
+        // An aggressing iceberg can fill past its peak, the hidden part trades too
+        displayed_quantity_ = (quantity >= displayed_quantity_) ? 0 : displayed_quantity_ - quantity;
+    }
     if (remaining_quantity_ == 0) {
         status_ = OrderStatus::Filled;
     }
+    else if (quantity > 0) {
+        status_ = OrderStatus::Partially_Filled;
+    }
 }
 void Order::cancel() {
     status_ = OrderStatus::Cancelled;
     remaining_quantity_ = 0;
+    displayed_quantity_ = 0;
+}
+bool Order::is_stop_order() const {
+    return order_type_ == OrderType::Stop || order_type_ == OrderType::Stop_Limit;
+}
+// Buy stops fire once the market trades at or above the stop price,
+// sell stops once it trades at or below it
+bool Order::is_triggered_by(Price last_trade_price) const {
+    if (!is_stop_order()) {
+        return false;
+    }
+    if (side_ == Side::Buy) {
+        return last_trade_price >= stop_price_;
+    }
+    return last_trade_price <= stop_price_;
+}
+// A triggered stop becomes a market order, a triggered stop-limit a limit order
+void Order::trigger() {
+    if (order_type_ == OrderType::Stop) {
+        order_type_ = OrderType::Market;
+    }
+    else if (order_type_ == OrderType::Stop_Limit) {
+        order_type_ = OrderType::Limit;
+    }
+    else {
+        throw std::logic_error("Only stop orders can be triggered");
+    }
+}
+// Market and stop orders execute at whatever price the book offers, so their
+// limit price is ignored and may be left as zero
+bool Order::is_price_agnostic() const {
+    return order_type_ == OrderType::Market || order_type_ == OrderType::Stop;
+}
+bool Order::is_iceberg() const { return order_type_ == OrderType::Iceberg; }
+bool Order::needs_replenish() const {
+    return is_iceberg() && displayed_quantity_ == 0 && remaining_quantity_ > 0;
+}
+// Shows the next peak out of the hidden reserve and returns the displayed quantity
+Quantity Order::replenish() {
+    if (!is_iceberg()) {
+        throw std::logic_error("Only iceberg orders can be replenished");
+    }
+    displayed_quantity_ = std::min(peak_quantity_, remaining_quantity_);
+    return displayed_quantity_;
 }
 bool Order::is_filled() const {
     return remaining_quantity_ == 0;
@@ -48,9 +126,10 @@ bool Order::is_partially_filled() const {
 }
 bool Order::is_valid() const {
     return (
-        is_valid_side(side_) && is_valid_price(price_) &&
+        is_valid_side(side_) && (is_price_agnostic() || is_valid_price(price_)) &&
         is_valid_quantity(quantity_) && remaining_quantity_ <= quantity_ &&
-        !symbol_.empty()
+        !symbol_.empty() && (!is_stop_order() || is_valid_price(stop_price_)) &&
+        (!is_iceberg() || (is_valid_quantity(peak_quantity_) && peak_quantity_ <= quantity_))
     );
 }
 bool Order::is_valid_side(Side side) { return (side == Side::Sell || side == Side::Buy); }
@@ -59,7 +138,10 @@ bool Order::is_valid_quantity(Quantity quantity) { return quantity > 0; }
 
 bool Order::can_match_with(const Order& other) const {
     bool valid_price = false;
-    if (side_ == Side::Buy && price_ >= other.price_) {
+    if (order_type_ == OrderType::Market) {
+        valid_price = true;
+    }
+    else if (side_ == Side::Buy && price_ >= other.price_) {
         valid_price = true;
     }
     else if (side_ == Side::Sell && price_ <= other.price_) {
@@ -74,15 +156,24 @@ Quantity Order::get_fillable_quantity(const Order& other) const {
     if (!can_match_with(other)) {
         return 0;
     }
-    return std::min(remaining_quantity_, other.remaining_quantity_);
+    return std::min(remaining_quantity_, other.get_displayed_quantity());
 }
 std::string Order::to_string() const {
     std::string side_str = (side_ == Side::Buy) ? "Buy" : "Sell";
-    std::string type_str = (order_type_ == OrderType::Market) ? "Market" : "Limit";
+    std::string type_str;
+    switch (order_type_) {
+        case OrderType::Market: type_str = "Market"; break;
+        case OrderType::Limit: type_str = "Limit"; break;
+        case OrderType::Stop: type_str = "Stop"; break;
+        case OrderType::Stop_Limit: type_str = "Stop Limit"; break;
+        case OrderType::Iceberg: type_str = "Iceberg"; break;
+    }
+    std::string stop_str = is_stop_order() ? ", Stop Price: " + std::to_string(stop_price_) : "";
+    std::string peak_str = is_iceberg() ? ", Peak: " + std::to_string(peak_quantity_) : "";
     return (
         "Order [ID: " + std::to_string(order_id_) + ", Symbol: " + symbol_ + ", Price: " +
-        std::to_string(price_) + ", Side: " + side_str + ", Quantity: " +
-        std::to_string(quantity_) + ", Type: " + type_str + ", Timestamp: " +
+        std::to_string(price_) + stop_str + ", Side: " + side_str + ", Quantity: " +
+        std::to_string(quantity_) + peak_str + ", Type: " + type_str + ", Timestamp: " +
         std::to_string(timestamp_) + "]\n"
     );
 }
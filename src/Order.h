@@ -8,27 +8,48 @@ private:
     OrderId order_id_;
     Side side_;
     Price price_;
+    Price stop_price_;
     Quantity quantity_;
     Quantity remaining_quantity_;
+    Quantity filled_quantity_;
+    Quantity peak_quantity_;
+    Quantity displayed_quantity_;
     const Symbol& symbol_;
     Timestamp timestamp_;
     OrderType order_type_;
     OrderStatus status_;
+    Order(OrderId order_id, Side side, Price price, Quantity quantity, const Symbol& symbol,
+          Timestamp timestamp, OrderType order_type, Price stop_price, Quantity peak_quantity);
 public:
     Order(OrderId order_id, Side side, Price price, Quantity quantity, const Symbol& symbol,
           Timestamp timestamp, OrderType order_type);
+    Order(OrderId order_id, Side side, Price price, Quantity quantity, const Symbol& symbol,
+          Timestamp timestamp, OrderType order_type, Price stop_price);
+    Order(OrderId order_id, Side side, Price price, Quantity quantity, Quantity peak_quantity,
+          const Symbol& symbol, Timestamp timestamp);
     OrderId get_order_id() const;
     Side get_side() const;
     Price get_price() const;
+    Price get_stop_price() const;
     Quantity get_quantity() const;
     Quantity get_remaining_quantity() const;
     Quantity get_filled_quantity() const;
+    Quantity get_peak_quantity() const;
+    Quantity get_displayed_quantity() const;
     const Symbol& get_symbol() const;
     Timestamp get_timestamp() const;
     OrderType get_order_type() const;
     OrderStatus get_status() const;
+    void accept();
     void fill(Quantity);
     void cancel();
+    bool is_stop_order() const;
+    bool is_triggered_by(Price last_trade_price) const;
+    void trigger();
+    bool is_price_agnostic() const;
+    bool is_iceberg() const;
+    bool needs_replenish() const;
+    Quantity replenish();
     bool is_filled() const;
     bool is_partially_filled() const;
     bool is_valid() const;
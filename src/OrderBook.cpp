@@ -11,15 +11,18 @@
 OrderBook::OrderBook(const Symbol &symbol)
     : ask_levels_(),
       bid_levels_(),
+      buy_stops_(),
+      sell_stops_(),
       order_lookup_(),
       symbol_(symbol),
-      total_orders_(0) {
+      total_orders_(0),
+      last_trade_price_() {
 }
 
 void OrderBook::remove_empty_price_level(Price price, Side side) {
     if (side == Side::Buy) {
         auto it = bid_levels_.find(price);
-        if (it != bid_levels_.end() && it->second.empty()) {
+        if (it != bid_levels_.end() && it->second.orders.empty()) {
             bid_levels_.erase(it);
         }
         else {
@@ -28,7 +31,7 @@ void OrderBook::remove_empty_price_level(Price price, Side side) {
     }
     else {
         auto it = ask_levels_.find(price);
-        if (it != ask_levels_.end() && it->second.empty()) {
+        if (it != ask_levels_.end() && it->second.orders.empty()) {
             ask_levels_.erase(it);
         }
         else {
@@ -36,7 +39,7 @@ void OrderBook::remove_empty_price_level(Price price, Side side) {
         }
     }
 }
-std::queue<Order*>& OrderBook::get_price_level(Price price, Side side) {
+PriceLevel& OrderBook::get_price_level(Price price, Side side) {
     if (side == Side::Buy) {
         auto it = bid_levels_.find(price);
         if (it != bid_levels_.end()) {
@@ -49,6 +52,7 @@ std::queue<Order*>& OrderBook::get_price_level(Price price, Side side) {
             return it->second;
         }
     }
+    throw std::logic_error("Price level does not exist");
 }
 
 void OrderBook::add_order(Order* order) {
@@ -62,57 +66,141 @@ void OrderBook::add_order(Order* order) {
         throw std::invalid_argument("OrderId already exists");
     }
 
+    if (order->is_iceberg()) {
+        order->replenish();
+    }
+    PriceLevel& level = (order->get_side() == Side::Buy) ? bid_levels_[order->get_price()]
+                                                         : ask_levels_[order->get_price()];
+    level.orders.push(order);
+    level.displayed_quantity += order->get_displayed_quantity();
+    order_lookup_[order->get_order_id()] = order;
+
+}
+void OrderBook::add_stop_order(Order* order) {
+    if (!order) {
+        throw std::invalid_argument("Order can not be null");
+    }
+    if (!order->is_valid() || !order->is_stop_order()) {
+        throw std::invalid_argument("Invalid stop order");
+    }
+    if (order_lookup_.find(order->get_order_id()) != order_lookup_.end()) {
+        throw std::invalid_argument("OrderId already exists");
+    }
+
     if (order->get_side() == Side::Buy) {
-        bid_levels_[order->get_price()].push(order);
+        buy_stops_[order->get_stop_price()].push(order);
     }
     else {
-        ask_levels_[order->get_price()].push(order);
+        sell_stops_[order->get_stop_price()].push(order);
     }
     order_lookup_[order->get_order_id()] = order;
-
 }
-void OrderBook::cancel_order(OrderId order_id) {
-    auto it = order_lookup_.find(order_id);
-    if (it == order_lookup_.end()) {
-        throw std::invalid_argument("Can't cancel an nonexistent order");
-    }
-    Side side = it->second->get_side();
-    Price price = it->second->get_price();
-    if (side == Side::Buy) {
-        std::queue<Order*> cur_bids_queue = get_price_level(price, side);
-        std::queue<Order*> new_bids_queue;
-        while (!cur_bids_queue.empty()) {
-            Order* order = cur_bids_queue.front();
-            cur_bids_queue.pop();
-            if (order->get_order_id() != order_id) {
-                new_bids_queue.push(order);
+void OrderBook::remove_stop_order(Order* order) {
+    Price stop_price = order->get_stop_price();
+    auto remove_from = [&](auto& stops) {
+        auto level = stops.find(stop_price);
+        if (level == stops.end()) {
+            throw std::logic_error("Stop order is missing from the trigger index");
+        }
+        std::queue<Order*> remaining;
+        while (!level->second.empty()) {
+            if (level->second.front() != order) {
+                remaining.push(level->second.front());
             }
+            level->second.pop();
         }
-        if (new_bids_queue.empty()) {
-            remove_empty_price_level(price, side);
+        if (remaining.empty()) {
+            stops.erase(level);
         }
         else {
-            bid_levels_[price] = new_bids_queue;
+            level->second = std::move(remaining);
+        }
+    };
+    if (order->get_side() == Side::Buy) {
+        remove_from(buy_stops_);
+    }
+    else {
+        remove_from(sell_stops_);
+    }
+}
+// Both stop indexes are ordered so that the next stop to fire sits at begin(),
+// so a trade only walks the stops it actually triggers. Buy stops are checked
+// against the highest price traded and sell stops against the lowest
+void OrderBook::collect_triggered_stops(Price low_price, Price high_price, std::queue<Order*>& triggered) {
+    while (!buy_stops_.empty() && buy_stops_.begin()->first <= high_price) {
+        auto& level = buy_stops_.begin()->second;
+        while (!level.empty()) {
+            order_lookup_.erase(level.front()->get_order_id());
+            triggered.push(level.front());
+            level.pop();
         }
+        buy_stops_.erase(buy_stops_.begin());
+    }
+    while (!sell_stops_.empty() && sell_stops_.begin()->first >= low_price) {
+        auto& level = sell_stops_.begin()->second;
+        while (!level.empty()) {
+            order_lookup_.erase(level.front()->get_order_id());
+            triggered.push(level.front());
+            level.pop();
+        }
+        sell_stops_.erase(sell_stops_.begin());
+    }
+}
+std::optional<Price> OrderBook::get_last_trade_price() const { return last_trade_price_; }
+void OrderBook::set_last_trade_price(Price price) { last_trade_price_ = price; }
+OrderCount OrderBook::get_stop_order_count() const {
+    OrderCount count = 0;
+    for (const auto& [price, level] : buy_stops_) {
+        count += level.size();
+    }
+    for (const auto& [price, level] : sell_stops_) {
+        count += level.size();
+    }
+    return count;
+}
+
+Order* OrderBook::cancel_order(OrderId order_id) {
+    auto it = order_lookup_.find(order_id);
+    if (it == order_lookup_.end()) {
+        throw std::invalid_argument("Can't cancel an nonexistent order");
+    }
+    Order* order = it->second;
+    if (order->is_stop_order()) {
+        remove_stop_order(order);
     }
     else {
-        std::queue<Order*> cur_asks_queue = get_price_level(price, side);
-        std::queue<Order*> new_asks_queue;
-        while (!cur_asks_queue.empty()) {
-            Order* order = cur_asks_queue.front();
-            cur_asks_queue.pop();
-            if (order->get_order_id() != order_id) {
-                new_asks_queue.push(order);
+        Side side = order->get_side();
+        Price price = order->get_price();
+        PriceLevel& level = get_price_level(price, side);
+        std::queue<Order*> remaining_orders;
+        while (!level.orders.empty()) {
+            if (level.orders.front() != order) {
+                remaining_orders.push(level.orders.front());
             }
+            level.orders.pop();
         }
-        if (new_asks_queue.empty()) {
+        level.orders = std::move(remaining_orders);
+        level.displayed_quantity -= order->get_displayed_quantity();
+        if (level.orders.empty()) {
             remove_empty_price_level(price, side);
         }
-        else {
-            ask_levels_[price] = new_asks_queue;
-        }
     }
     order_lookup_.erase(it);
+    order->cancel();
+    return order;
+}
+// Removes the fully filled order at the front of a level from both the level
+// and the order index, dropping the level once it empties
+void OrderBook::pop_filled_order(Price price, Side side) {
+    PriceLevel& level = get_price_level(price, side);
+    if (level.orders.empty() || !level.orders.front()->is_filled()) {
+        throw std::logic_error("Front of price level is not a filled order");
+    }
+    order_lookup_.erase(level.orders.front()->get_order_id());
+    level.orders.pop();
+    if (level.orders.empty()) {
+        remove_empty_price_level(price, side);
+    }
 }
 
 std::optional<Price> OrderBook::get_best_bid() const {
@@ -143,31 +231,13 @@ std::vector<MarketDepthLevel> OrderBook::get_market_depth(int levels, Side side)
     if (side == Side::Buy) {
         auto it = bid_levels_.begin();
         for (int i = 0; i < levels && it != bid_levels_.end(); ++i, ++it) {
-            Quantity total_qty = 0;
-            OrderCount order_count = 0;
-
-            std::queue<Order*> temp_queue = it->second;
-            while(!temp_queue.empty()) {
-                total_qty += temp_queue.front()->get_remaining_quantity();
-                order_count++;
-                temp_queue.pop();
-            }
-            depth.emplace_back(it->first, total_qty, order_count);
+            depth.emplace_back(it->first, it->second.displayed_quantity, it->second.orders.size());
         }
     }
     else {
         auto it = ask_levels_.begin();
         for (int i = 0; i < levels && it != ask_levels_.end(); ++i, ++it) {
-            Quantity total_qty = 0;
-            OrderCount order_count = 0;
-
-            std::queue<Order*> temp_queue = it->second;
-            while(!temp_queue.empty()) {
-                total_qty += temp_queue.front()->get_remaining_quantity();
-                order_count++;
-                temp_queue.pop();
-            }
-            depth.emplace_back(it->first, total_qty, order_count);
+            depth.emplace_back(it->first, it->second.displayed_quantity, it->second.orders.size());
         }
     }
     return depth;
@@ -179,7 +249,7 @@ const Symbol& OrderBook::get_symbol() const { return symbol_; }
 OrderCount OrderBook::get_bid_level_count() const { return bid_levels_.size(); }
 OrderCount OrderBook::get_ask_level_count() const { return ask_levels_.size(); }
 
-std::queue<Order*>* OrderBook::get_best_orders(Side incoming_side) {
+PriceLevel* OrderBook::get_best_level(Side incoming_side) {
     if (incoming_side == Side::Buy) {
         if (!ask_levels_.empty()) {
             return &ask_levels_.begin()->second;
@@ -5,24 +5,45 @@
 #include <unordered_map>
 #include <optional>
 #include <map>
+#include <vector>
 
 class Order;
-using Asks = std::map<Price, std::queue<Order*>, std::less<Price>>;
-using Bids = std::map<Price, std::queue<Order*>, std::greater<Price>>;
+
+// Orders at one price in time priority, along with the displayed quantity
+// they show so depth queries never have to walk the queue
+struct PriceLevel {
+    std::queue<Order*> orders;
+    Quantity displayed_quantity = 0;
+};
+
+using Asks = std::map<Price, PriceLevel, std::less<Price>>;
+using Bids = std::map<Price, PriceLevel, std::greater<Price>>;
+using BuyStops = std::map<Price, std::queue<Order*>, std::less<Price>>;
+using SellStops = std::map<Price, std::queue<Order*>, std::greater<Price>>;
 
 class OrderBook {
 private:
     Asks ask_levels_;
     Bids bid_levels_;
+    BuyStops buy_stops_;
+    SellStops sell_stops_;
     std::unordered_map<OrderId, Order*> order_lookup_;
     Symbol symbol_;
     OrderCount total_orders_;
+    std::optional<Price> last_trade_price_;
     void remove_empty_price_level(Price price, Side side);
-    std::queue<Order*>& get_price_level(Price price, Side side);
+    PriceLevel& get_price_level(Price price, Side side);
+    void remove_stop_order(Order* order);
 public:
     OrderBook(const Symbol& symbol);
     void add_order(Order* order);
-    void cancel_order(OrderId order_id);
+    void add_stop_order(Order* order);
+    Order* cancel_order(OrderId order_id);
+    void pop_filled_order(Price price, Side side);
+    void collect_triggered_stops(Price low_price, Price high_price, std::queue<Order*>& triggered);
+    std::optional<Price> get_last_trade_price() const;
+    void set_last_trade_price(Price price);
+    OrderCount get_stop_order_count() const;
     std::optional<Price> get_best_bid() const;
     std::optional<Price> get_best_ask() const;
     std::optional<Price> get_spread() const;
@@ -32,7 +53,7 @@ public:
     const Symbol& get_symbol() const;
     OrderCount get_bid_level_count() const;
     OrderCount get_ask_level_count() const;
-    std::queue<Order*>* get_best_orders(Side incoming_side);
+    PriceLevel* get_best_level(Side incoming_side);
     bool is_valid_order(const Order& order) const;
     std::string to_string() const;
     void cleanup_empty_price_level(Price price, Side side);
@@ -0,0 +1,96 @@
+#include "Types.h"
+#include "OrderStateService.h"
+#include "Order.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+OrderStateService::OrderStateService(OrderCount max_terminal_orders)
+    : order_states_(),
+      terminal_orders_(),
+      max_terminal_orders_(max_terminal_orders),
+      subscribers_(),
+      next_subscription_id_(0),
+      pending_reports_(),
+      publishing_(false),
+      handler_error_count_(0) {
+}
+
+void OrderStateService::retire_order(OrderId order_id) {
+    terminal_orders_.push_back(order_id);
+    while (terminal_orders_.size() > max_terminal_orders_) {
+        order_states_.erase(terminal_orders_.front());
+        terminal_orders_.pop_front();
+    }
+}
+void OrderStateService::record_update(const Order& order, Price fill_price, Quantity fill_qty,
+                                      Timestamp timestamp) {
+    OrderStatus status = order.get_status();
+    auto [it, inserted] = order_states_.try_emplace(order.get_order_id());
+    OrderStatus previous_status = inserted ? OrderStatus::Pending : it->second.status;
+    if (previous_status == OrderStatus::Filled || previous_status == OrderStatus::Cancelled) {
+        throw std::logic_error("Order already reached a terminal state");
+    }
+    it->second = OrderState{status, order.get_filled_quantity(), order.get_remaining_quantity()};
+
+    if (status == OrderStatus::Filled || status == OrderStatus::Cancelled) {
+        retire_order(order.get_order_id());
+    }
+    if (!subscribers_.empty()) {
+        pending_reports_.emplace_back(order.get_order_id(), order.get_symbol(), status, fill_price,
+                                      fill_qty, order.get_filled_quantity(),
+                                      order.get_remaining_quantity(), timestamp);
+    }
+}
+
+// Only the outermost call delivers. Reports recorded by a handler that calls
+// back into the engine are appended and drained after the current batch, and
+// (un)subscribing takes effect from the next batch
+void OrderStateService::publish_pending() {
+    if (publishing_) {
+        return;
+    }
+    publishing_ = true;
+    while (!pending_reports_.empty()) {
+        std::vector<ExecutionReport> reports;
+        reports.swap(pending_reports_);
+        auto subscribers = subscribers_;
+        for (const ExecutionReport& report : reports) {
+            for (const auto& [id, handler] : subscribers) {
+                try {
+                    handler(report);
+                }
+                catch (...) {
+                    ++handler_error_count_;
+                }
+            }
+        }
+    }
+    publishing_ = false;
+}
+
+std::optional<OrderState> OrderStateService::get_order_state(OrderId order_id) const {
+    auto it = order_states_.find(order_id);
+    if (it == order_states_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+bool OrderStateService::is_tracked(OrderId order_id) const {
+    return order_states_.find(order_id) != order_states_.end();
+}
+OrderCount OrderStateService::get_tracked_order_count() const { return order_states_.size(); }
+OrderCount OrderStateService::get_handler_error_count() const { return handler_error_count_; }
+
+SubscriptionId OrderStateService::subscribe(ExecutionReportHandler handler) {
+    if (!handler) {
+        throw std::invalid_argument("Execution report handler can not be empty");
+    }
+    subscribers_.emplace_back(next_subscription_id_, std::move(handler));
+    return next_subscription_id_++;
+}
+void OrderStateService::unsubscribe(SubscriptionId subscription_id) {
+    std::erase_if(subscribers_, [subscription_id](const auto& subscriber) {
+        return subscriber.first == subscription_id;
+    });
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Types.h"
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Order;
+
+using SubscriptionId = uint64_t;
+using ExecutionReportHandler = std::function<void(const ExecutionReport&)>;
+
+struct OrderState {
+    OrderStatus status;
+    Quantity filled_qty;
+    Quantity remaining_qty;
+};
+
+// Engine-wide order lifecycle table. Live orders are kept until they reach a
+// terminal state, after which only the most recent max_terminal_orders stay
+// queryable. Updates are buffered as execution reports and pushed to the
+// subscribers by publish_pending, once the engine's books are consistent.
+// Reports reach subscribers in the order they were recorded, even when a
+// handler calls back into the engine. A handler that throws is skipped for
+// that report and counted in get_handler_error_count; the exception never
+// reaches the engine caller
+class OrderStateService {
+private:
+    std::unordered_map<OrderId, OrderState> order_states_;
+    std::deque<OrderId> terminal_orders_;
+    OrderCount max_terminal_orders_;
+    std::vector<std::pair<SubscriptionId, ExecutionReportHandler>> subscribers_;
+    SubscriptionId next_subscription_id_;
+    std::vector<ExecutionReport> pending_reports_;
+    bool publishing_;
+    OrderCount handler_error_count_;
+    void retire_order(OrderId order_id);
+public:
+    explicit OrderStateService(OrderCount max_terminal_orders);
+    void record_update(const Order& order, Price fill_price, Quantity fill_qty, Timestamp timestamp);
+    void publish_pending();
+    std::optional<OrderState> get_order_state(OrderId order_id) const;
+    bool is_tracked(OrderId order_id) const;
+    OrderCount get_tracked_order_count() const;
+    OrderCount get_handler_error_count() const;
+    SubscriptionId subscribe(ExecutionReportHandler handler);
+    void unsubscribe(SubscriptionId subscription_id);
+};
@@ -19,11 +19,11 @@ enum class Side {
 };
 
 enum class OrderStatus {
-    Pending, Partially_Filled, Filled, Cancelled
+    Pending, Accepted, Partially_Filled, Filled, Cancelled
 };
 
 enum class OrderType {
-    Market, Limit
+    Market, Limit, Stop, Stop_Limit, Iceberg
 };
 
 struct MarketDepthLevel {
@@ -37,3 +37,26 @@ struct MarketDepthLevel {
         order_count(count) {
     }
 };
+
+struct ExecutionReport {
+    OrderId order_id;
+    Symbol symbol;
+    OrderStatus status;
+    Price last_fill_price;
+    Quantity last_fill_qty;
+    Quantity filled_qty;
+    Quantity remaining_qty;
+    Timestamp timestamp;
+
+    ExecutionReport(OrderId id, const Symbol& sym, OrderStatus st, Price fill_price,
+                    Quantity fill_qty, Quantity filled, Quantity remaining, Timestamp ts) :
+        order_id(id),
+        symbol(sym),
+        status(st),
+        last_fill_price(fill_price),
+        last_fill_qty(fill_qty),
+        filled_qty(filled),
+        remaining_qty(remaining),
+        timestamp(ts) {
+    }
+};
@@ -0,0 +1,352 @@
+#include "Types.h"
+#include "MatchingEngine.h"
+#include "OrderBook.h"
+#include "Order.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond \
+                      << "\n";                                                   \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+static const Symbol SYMBOL = "AAPL";
+static const Symbol OTHER_SYMBOL = "MSFT";
+
+using ReportLog = std::vector<std::pair<OrderId, OrderStatus>>;
+
+// Prints a trade at 100 so the book has a last trade price
+static void seed_last_trade(MatchingEngine& engine, Order& ask, Order& bid) {
+    engine.submit_order(&ask);
+    engine.submit_order(&bid);
+}
+
+static void test_stop_cascade_in_single_submit() {
+    MatchingEngine engine;
+    Order ask_100(1, Side::Sell, 100, 10, SYMBOL, 0, OrderType::Limit);
+    Order ask_105(2, Side::Sell, 105, 10, SYMBOL, 0, OrderType::Limit);
+    Order ask_110(3, Side::Sell, 110, 10, SYMBOL, 0, OrderType::Limit);
+    engine.submit_order(&ask_100);
+    engine.submit_order(&ask_105);
+    engine.submit_order(&ask_110);
+
+    Order stop(4, Side::Buy, 0, 10, SYMBOL, 0, OrderType::Stop, 100);
+    Order stop_limit(5, Side::Buy, 110, 5, SYMBOL, 0, OrderType::Stop_Limit, 105);
+    CHECK(engine.submit_order(&stop).empty());
+    CHECK(engine.submit_order(&stop_limit).empty());
+    CHECK(engine.get_order_book(SYMBOL)->get_stop_order_count() == 2);
+
+    Order buy(6, Side::Buy, 100, 10, SYMBOL, 0, OrderType::Limit);
+    TradeList trades = engine.submit_order(&buy);
+
+    CHECK(trades.size() == 3);
+    CHECK(trades.size() == 3 && trades[0].get_buy_id() == 6 && trades[0].get_price() == 100);
+    CHECK(trades.size() == 3 && trades[1].get_buy_id() == 4 && trades[1].get_price() == 105);
+    CHECK(trades.size() == 3 && trades[2].get_buy_id() == 5 && trades[2].get_price() == 110);
+    const OrderBook* book = engine.get_order_book(SYMBOL);
+    CHECK(book->get_stop_order_count() == 0);
+    CHECK(book->get_last_trade_price() == 110);
+    CHECK(book->get_best_ask() == 110);
+}
+
+static void test_sell_stop_traded_through_by_buy_sweep() {
+    MatchingEngine engine;
+    Order seed_ask(1, Side::Sell, 100, 1, SYMBOL, 0, OrderType::Limit);
+    Order seed_bid(2, Side::Buy, 100, 1, SYMBOL, 0, OrderType::Limit);
+    seed_last_trade(engine, seed_ask, seed_bid);
+
+    Order bid_90(3, Side::Buy, 90, 5, SYMBOL, 0, OrderType::Limit);
+    Order sell_stop(4, Side::Sell, 90, 5, SYMBOL, 0, OrderType::Stop_Limit, 97);
+    Order ask_95(5, Side::Sell, 95, 1, SYMBOL, 0, OrderType::Limit);
+    Order ask_105(6, Side::Sell, 105, 1, SYMBOL, 0, OrderType::Limit);
+    engine.submit_order(&bid_90);
+    engine.submit_order(&sell_stop);
+    engine.submit_order(&ask_95);
+    engine.submit_order(&ask_105);
+
+    // Fills at 95 and then 105, the 95 print must still fire the stop at 97
+    Order buy(7, Side::Buy, 105, 2, SYMBOL, 0, OrderType::Limit);
+    TradeList trades = engine.submit_order(&buy);
+
+    CHECK(trades.size() == 3);
+    CHECK(trades.size() == 3 && trades[2].get_sell_id() == 4 && trades[2].get_price() == 90);
+    const OrderBook* book = engine.get_order_book(SYMBOL);
+    CHECK(book->get_stop_order_count() == 0);
+    CHECK(book->get_last_trade_price() == 90);
+}
+
+static void test_stop_already_triggered_on_submit() {
+    MatchingEngine engine;
+    Order seed_ask(1, Side::Sell, 100, 1, SYMBOL, 0, OrderType::Limit);
+    Order seed_bid(2, Side::Buy, 100, 1, SYMBOL, 0, OrderType::Limit);
+    seed_last_trade(engine, seed_ask, seed_bid);
+
+    Order ask(3, Side::Sell, 101, 5, SYMBOL, 0, OrderType::Limit);
+    engine.submit_order(&ask);
+
+    Order stop(4, Side::Buy, 0, 5, SYMBOL, 0, OrderType::Stop, 95);
+    TradeList trades = engine.submit_order(&stop);
+
+    CHECK(trades.size() == 1);
+    CHECK(trades.size() == 1 && trades[0].get_buy_id() == 4 && trades[0].get_quantity() == 5);
+    CHECK(stop.get_order_type() == OrderType::Market);
+    CHECK(engine.get_order_book(SYMBOL)->get_stop_order_count() == 0);
+}
+
+static void test_stop_limit_remainder_rests() {
+    MatchingEngine engine;
+    Order ask_100(1, Side::Sell, 100, 1, SYMBOL, 0, OrderType::Limit);
+    Order ask_101(2, Side::Sell, 101, 4, SYMBOL, 0, OrderType::Limit);
+    engine.submit_order(&ask_100);
+    engine.submit_order(&ask_101);
+
+    Order stop_limit(3, Side::Buy, 101, 10, SYMBOL, 0, OrderType::Stop_Limit, 100);
+    engine.submit_order(&stop_limit);
+
+    Order buy(4, Side::Buy, 100, 1, SYMBOL, 0, OrderType::Limit);
+    TradeList trades = engine.submit_order(&buy);
+
+    CHECK(trades.size() == 2);
+    CHECK(stop_limit.get_order_type() == OrderType::Limit);
+    CHECK(stop_limit.get_remaining_quantity() == 6);
+    const OrderBook* book = engine.get_order_book(SYMBOL);
+    CHECK(book->get_best_bid() == 101);
+    CHECK(!book->get_best_ask().has_value());
+    auto depth = book->get_market_depth(1, Side::Buy);
+    CHECK(depth.size() == 1 && depth[0].total_qty == 6 && depth[0].order_count == 1);
+}
+
+static void test_cancel_stop_before_and_after_trigger() {
+    MatchingEngine engine;
+    Order ask_100(1, Side::Sell, 100, 1, SYMBOL, 0, OrderType::Limit);
+    Order ask_101(2, Side::Sell, 101, 4, SYMBOL, 0, OrderType::Limit);
+    engine.submit_order(&ask_100);
+    engine.submit_order(&ask_101);
+
+    Order cancelled_stop(3, Side::Buy, 0, 4, SYMBOL, 0, OrderType::Stop, 100);
+    Order stop_limit(4, Side::Buy, 101, 10, SYMBOL, 0, OrderType::Stop_Limit, 100);
+    engine.submit_order(&cancelled_stop);
+    engine.submit_order(&stop_limit);
+
+    // Before the trigger the stop only lives in the trigger index
+    engine.cancel_order(SYMBOL, 3);
+    CHECK(cancelled_stop.get_status() == OrderStatus::Cancelled);
+    CHECK(engine.get_order_book(SYMBOL)->get_stop_order_count() == 1);
+
+    Order buy(5, Side::Buy, 100, 1, SYMBOL, 0, OrderType::Limit);
+    TradeList trades = engine.submit_order(&buy);
+    CHECK(trades.size() == 2);
+    CHECK(trades.size() == 2 && trades[1].get_buy_id() == 4);
+    CHECK(ask_101.is_filled());
+
+    // After the trigger the remainder rests as a plain limit order
+    engine.cancel_order(SYMBOL, 4);
+    const OrderBook* book = engine.get_order_book(SYMBOL);
+    CHECK(stop_limit.get_status() == OrderStatus::Cancelled);
+    CHECK(book->get_bid_level_count() == 0);
+    CHECK(book->get_stop_order_count() == 0);
+    CHECK(book->is_empty());
+}
+
+static void test_iceberg_depth_and_replenish_priority() {
+    MatchingEngine engine;
+    Order iceberg(1, Side::Sell, 100, 30, 10, SYMBOL, 0);
+    Order limit(2, Side::Sell, 100, 5, SYMBOL, 1, OrderType::Limit);
+    engine.submit_order(&iceberg);
+    engine.submit_order(&limit);
+
+    const OrderBook* book = engine.get_order_book(SYMBOL);
+    auto depth = book->get_market_depth(1, Side::Sell);
+    CHECK(depth.size() == 1 && depth[0].total_qty == 15 && depth[0].order_count == 2);
+
+    // Consuming the displayed peak refills it behind the later limit order
+    Order first_buy(3, Side::Buy, 100, 10, SYMBOL, 2, OrderType::Limit);
+    TradeList trades = engine.submit_order(&first_buy);
+    CHECK(trades.size() == 1 && trades[0].get_sell_id() == 1 && trades[0].get_quantity() == 10);
+    CHECK(iceberg.get_remaining_quantity() == 20);
+    CHECK(iceberg.get_displayed_quantity() == 10);
+    depth = book->get_market_depth(1, Side::Sell);
+    CHECK(depth.size() == 1 && depth[0].total_qty == 15 && depth[0].order_count == 2);
+
+    Order second_buy(4, Side::Buy, 100, 7, SYMBOL, 3, OrderType::Limit);
+    trades = engine.submit_order(&second_buy);
+    CHECK(trades.size() == 2);
+    CHECK(trades.size() == 2 && trades[0].get_sell_id() == 2 && trades[0].get_quantity() == 5);
+    CHECK(trades.size() == 2 && trades[1].get_sell_id() == 1 && trades[1].get_quantity() == 2);
+    depth = book->get_market_depth(1, Side::Sell);
+    CHECK(depth.size() == 1 && depth[0].total_qty == 8 && depth[0].order_count == 1);
+}
+
+static void test_order_state_lifecycle() {
+    MatchingEngine engine;
+    ReportLog reports;
+    engine.subscribe_execution_reports([&reports](const ExecutionReport& report) {
+        reports.emplace_back(report.order_id, report.status);
+    });
+
+    Order ask(1, Side::Sell, 100, 10, SYMBOL, 0, OrderType::Limit);
+    engine.submit_order(&ask);
+    CHECK(engine.get_order_state(1)->status == OrderStatus::Accepted);
+
+    Order partial_buy(2, Side::Buy, 100, 4, SYMBOL, 1, OrderType::Limit);
+    engine.submit_order(&partial_buy);
+    auto state = engine.get_order_state(1);
+    CHECK(state->status == OrderStatus::Partially_Filled);
+    CHECK(state->filled_qty == 4 && state->remaining_qty == 6);
+
+    Order final_buy(3, Side::Buy, 100, 6, SYMBOL, 2, OrderType::Limit);
+    engine.submit_order(&final_buy);
+    CHECK(engine.get_order_state(1)->status == OrderStatus::Filled);
+
+    Order cancelled_ask(4, Side::Sell, 100, 10, SYMBOL, 3, OrderType::Limit);
+    Order buy(5, Side::Buy, 100, 3, SYMBOL, 4, OrderType::Limit);
+    engine.submit_order(&cancelled_ask);
+    engine.submit_order(&buy);
+    engine.cancel_order(SYMBOL, 4);
+    state = engine.get_order_state(4);
+    CHECK(state->status == OrderStatus::Cancelled);
+    CHECK(state->filled_qty == 3 && state->remaining_qty == 0);
+
+    ReportLog order_one;
+    for (const auto& report : reports) {
+        if (report.first == 1) {
+            order_one.push_back(report);
+        }
+    }
+    CHECK((order_one == ReportLog{{1, OrderStatus::Accepted},
+                                  {1, OrderStatus::Partially_Filled},
+                                  {1, OrderStatus::Filled}}));
+}
+
+static void test_terminal_states_evicted_fifo() {
+    MatchingEngine engine(2);
+    Order live(1, Side::Buy, 90, 10, SYMBOL, 0, OrderType::Limit);
+    Order first(2, Side::Buy, 91, 10, SYMBOL, 1, OrderType::Limit);
+    Order second(3, Side::Buy, 92, 10, SYMBOL, 2, OrderType::Limit);
+    Order third(4, Side::Buy, 93, 10, SYMBOL, 3, OrderType::Limit);
+    engine.submit_order(&live);
+    engine.submit_order(&first);
+    engine.submit_order(&second);
+    engine.submit_order(&third);
+
+    engine.cancel_order(SYMBOL, 2);
+    engine.cancel_order(SYMBOL, 3);
+    CHECK(engine.get_order_state(2).has_value());
+    CHECK(engine.get_order_state(3).has_value());
+
+    engine.cancel_order(SYMBOL, 4);
+    CHECK(!engine.get_order_state(2).has_value());
+    CHECK(engine.get_order_state(3).has_value());
+    CHECK(engine.get_order_state(4).has_value());
+    CHECK(engine.get_order_state(1)->status == OrderStatus::Accepted);
+}
+
+static void test_fills_clean_up_order_index() {
+    MatchingEngine engine;
+    Order ask_100(1, Side::Sell, 100, 5, SYMBOL, 0, OrderType::Limit);
+    Order ask_101(2, Side::Sell, 101, 5, SYMBOL, 1, OrderType::Limit);
+    engine.submit_order(&ask_100);
+    engine.submit_order(&ask_101);
+
+    Order buy(3, Side::Buy, 101, 10, SYMBOL, 2, OrderType::Limit);
+    TradeList trades = engine.submit_order(&buy);
+
+    const OrderBook* book = engine.get_order_book(SYMBOL);
+    CHECK(trades.size() == 2);
+    CHECK(book->is_empty());
+    CHECK(book->get_ask_level_count() == 0 && book->get_bid_level_count() == 0);
+}
+
+static void test_duplicate_id_rejected_across_symbols() {
+    MatchingEngine engine;
+    Order order(1, Side::Buy, 100, 10, SYMBOL, 0, OrderType::Limit);
+    Order duplicate(1, Side::Buy, 100, 10, OTHER_SYMBOL, 1, OrderType::Limit);
+    engine.submit_order(&order);
+
+    bool rejected = false;
+    try {
+        engine.submit_order(&duplicate);
+    }
+    catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+    CHECK(!engine.has_order_book(OTHER_SYMBOL));
+    CHECK(engine.get_order_state(1)->status == OrderStatus::Accepted);
+}
+
+static void test_reports_ordered_when_handler_reenters() {
+    MatchingEngine engine;
+    ReportLog reports;
+    engine.subscribe_execution_reports([&](const ExecutionReport& report) {
+        if (report.order_id == 2 && report.status == OrderStatus::Accepted) {
+            engine.cancel_order(SYMBOL, 2);
+        }
+    });
+    engine.subscribe_execution_reports([&reports](const ExecutionReport& report) {
+        reports.emplace_back(report.order_id, report.status);
+    });
+
+    Order ask(1, Side::Sell, 100, 5, SYMBOL, 0, OrderType::Limit);
+    Order buy(2, Side::Buy, 100, 10, SYMBOL, 1, OrderType::Limit);
+    engine.submit_order(&ask);
+    engine.submit_order(&buy);
+
+    CHECK((reports == ReportLog{{1, OrderStatus::Accepted},
+                                {2, OrderStatus::Accepted},
+                                {1, OrderStatus::Filled},
+                                {2, OrderStatus::Partially_Filled},
+                                {2, OrderStatus::Cancelled}}));
+    CHECK(engine.get_order_state(2)->status == OrderStatus::Cancelled);
+    CHECK(engine.get_order_book(SYMBOL)->is_empty());
+}
+
+static void test_throwing_handler_does_not_drop_reports() {
+    MatchingEngine engine;
+    ReportLog reports;
+    engine.subscribe_execution_reports([](const ExecutionReport&) {
+        throw std::runtime_error("subscriber failure");
+    });
+    engine.subscribe_execution_reports([&reports](const ExecutionReport& report) {
+        reports.emplace_back(report.order_id, report.status);
+    });
+
+    Order ask(1, Side::Sell, 100, 5, SYMBOL, 0, OrderType::Limit);
+    Order buy(2, Side::Buy, 100, 5, SYMBOL, 1, OrderType::Limit);
+    engine.submit_order(&ask);
+    engine.submit_order(&buy);
+
+    CHECK(reports.size() == 4);
+    CHECK(engine.get_execution_report_error_count() == 4);
+}
+
+int main() {
+    test_stop_cascade_in_single_submit();
+    test_sell_stop_traded_through_by_buy_sweep();
+    test_stop_already_triggered_on_submit();
+    test_stop_limit_remainder_rests();
+    test_cancel_stop_before_and_after_trigger();
+    test_iceberg_depth_and_replenish_priority();
+    test_order_state_lifecycle();
+    test_terminal_states_evicted_fifo();
+    test_fills_clean_up_order_index();
+    test_duplicate_id_rejected_across_symbols();
+    test_reports_ordered_when_handler_reenters();
+    test_throwing_handler_does_not_drop_reports();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}